@@ -0,0 +1,99 @@
+// A benchmark comparing gradient evaluation with the runtime-width
+// dynamic_vector against the compile-time width vector at matching widths.
+//
+// Usage: bench_dynamic_vector [evals_per_width]
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <span>
+#include <utility>
+#include <vector>
+#include <wfwdiff/wfwdiff.hpp>
+
+using scalar_t = wfwdiff::var<double, double>;
+using dyn_t = wfwdiff::var<double, wfwdiff::dynamic_vector<double>>;
+
+template <size_t W>
+using fixed_t = wfwdiff::var<double, wfwdiff::vector<double, W>>;
+
+// A smooth objective coupling neighbouring parameters
+template <typename V> V objective(std::span<const V> p) {
+  V sum = 0.0;
+  for (size_t i = 0; i + 1 < p.size(); ++i)
+    sum = sum + p[i] * p[i + 1] + std::sin(p[i]) * 0.5;
+
+  return sum;
+}
+
+template <size_t W, size_t... Is>
+double run_fixed(const std::array<scalar_t, W> &params, const size_t evals,
+                 std::index_sequence<Is...>) {
+  double sink = 0.0;
+  for (size_t i = 0; i < evals; ++i) {
+    const auto ans = wfwdiff::eval(
+        [](auto... p) {
+          const std::array<fixed_t<W>, W> args = {p...};
+          return objective<fixed_t<W>>(args);
+        },
+        wfwdiff::parallelWrt(params[Is]...), wfwdiff::at(params[Is]...));
+    sink += ans.grad[W - 1];
+  }
+
+  return sink;
+}
+
+template <size_t W>
+double run_dynamic(const std::array<scalar_t, W> &params, const size_t evals) {
+  double sink = 0.0;
+  for (size_t i = 0; i < evals; ++i) {
+    const auto ans = wfwdiff::eval(objective<dyn_t>, wfwdiff::dynamicWrt(params),
+                                   wfwdiff::at(params));
+    sink += ans.grad[W - 1];
+  }
+
+  return sink;
+}
+
+template <typename F> double time(F &&run, double &sink) {
+  const auto start = std::chrono::steady_clock::now();
+  sink += run();
+  const std::chrono::duration<double> elapsed =
+      std::chrono::steady_clock::now() - start;
+
+  return elapsed.count();
+}
+
+template <size_t W> void bench(const size_t evals) {
+  std::array<scalar_t, W> params;
+  for (size_t i = 0; i < W; ++i)
+    params[i] = scalar_t(0.1 * static_cast<double>(i));
+
+  double sink = 0.0;
+  const double fixed = time(
+      [&]() {
+        return run_fixed(params, evals, std::make_index_sequence<W>());
+      },
+      sink);
+  const double dynamic =
+      time([&]() { return run_dynamic(params, evals); }, sink);
+
+  std::cout << "width=" << W << " vector=" << evals / fixed
+            << " evals/s dynamic_vector=" << evals / dynamic
+            << " evals/s ratio=" << dynamic / fixed << " checksum=" << sink
+            << "\n";
+}
+
+int main(int argc, char **argv) {
+  const size_t evals = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 100000;
+
+  bench<2>(evals);
+  bench<4>(evals);
+  bench<8>(evals);
+  bench<16>(evals);
+  bench<32>(evals);
+
+  return 0;
+}
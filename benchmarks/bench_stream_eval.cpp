@@ -0,0 +1,118 @@
+// A benchmark comparing the throughput and peak memory of streaming a
+// gradient over a memory-mapped dataset with eval_stream against reading the
+// whole file into a std::vector first and looping eval over it.
+//
+// Usage: bench_stream_eval <path> <mmap|vector> [chunk_bytes]
+// The dataset can be created with generate_dataset.
+//
+// Run each variant in its own process so that peak RSS is not shared between
+// them. The file is evicted from the page cache with posix_fadvise before the
+// timed run, so the numbers include reading it from disk. For fully cold runs
+// also drop the caches beforehand, e.g. with
+//   sync && echo 3 | sudo tee /proc/sys/vm/drop_caches
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <span>
+#include <string>
+#include <vector>
+#include <wfwdiff/stream.hpp>
+#include <wfwdiff/wfwdiff.hpp>
+
+#include <fcntl.h>
+#include <sys/resource.h>
+#include <unistd.h>
+
+using scalar_t = wfwdiff::var<double, double>;
+using vec_t = wfwdiff::var<double, wfwdiff::vector<double, 3>>;
+
+// Squared error of a linear model on a single (x1, x2, y) record
+vec_t loss(std::span<const double> record, vec_t a, vec_t b, vec_t c) {
+  const auto residual = a * record[0] + b * record[1] + c - vec_t(record[2]);
+  return residual * residual;
+}
+
+// Asks the kernel to drop the file's clean pages from the page cache
+bool evict_from_page_cache(const char *path) {
+  const int fd = ::open(path, O_RDONLY);
+  if (fd < 0)
+    return false;
+
+  const bool evicted = ::posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+  ::close(fd);
+
+  return evicted;
+}
+
+// Peak resident set size of this process in MB
+double peak_rss_mb() {
+  struct rusage usage {};
+  ::getrusage(RUSAGE_SELF, &usage);
+
+  // ru_maxrss is reported in kilobytes on Linux
+  return static_cast<double>(usage.ru_maxrss) / 1024.0;
+}
+
+void report(const std::string &name, const vec_t &total, const size_t bytes,
+            const std::chrono::duration<double> elapsed) {
+  std::cout << name << ": time=" << elapsed.count()
+            << "s MB/s=" << bytes / elapsed.count() / 1e6
+            << " peak_rss_MB=" << peak_rss_mb() << " loss=" << total.value
+            << " grad=" << total.grad << "\n";
+}
+
+int main(int argc, char **argv) {
+  const std::string variant = argc > 2 ? argv[2] : "";
+  if (variant != "mmap" && variant != "vector") {
+    std::cerr << "Usage: " << argv[0]
+              << " <path> <mmap|vector> [chunk_bytes]\n";
+    return 1;
+  }
+
+  const size_t chunk_bytes = argc > 3 ? std::strtoull(argv[3], nullptr, 10)
+                                      : wfwdiff::stream::DEFAULT_CHUNK_BYTES;
+
+  if (!evict_from_page_cache(argv[1]))
+    std::cerr << "Could not evict " << argv[1] << " from the page cache\n";
+
+  const scalar_t a = 1.0;
+  const scalar_t b = 0.0;
+  const scalar_t c = 0.0;
+
+  if (variant == "mmap") {
+    const auto start = std::chrono::steady_clock::now();
+
+    const wfwdiff::mapped_records<double> records(argv[1], 3);
+    const auto total = wfwdiff::eval_stream(
+        loss, wfwdiff::parallelWrt(a, b, c), records, chunk_bytes);
+
+    report(variant, total, records.bytes(),
+           std::chrono::steady_clock::now() - start);
+  } else {
+    const auto start = std::chrono::steady_clock::now();
+
+    std::ifstream in(argv[1], std::ios::binary | std::ios::ate);
+    const auto bytes = static_cast<size_t>(in.tellg());
+    std::vector<double> data(bytes / sizeof(double));
+    in.seekg(0);
+    in.read(reinterpret_cast<char *>(data.data()),
+            static_cast<std::streamsize>(bytes));
+
+    vec_t total;
+    for (size_t i = 0; i + 3 <= data.size(); i += 3) {
+      const auto record = std::span<const double>(data.data() + i, 3);
+      total = total + wfwdiff::eval(
+                          [record](vec_t pa, vec_t pb, vec_t pc) {
+                            return loss(record, pa, pb, pc);
+                          },
+                          wfwdiff::parallelWrt(a, b, c),
+                          wfwdiff::at(a, b, c));
+    }
+
+    report(variant, total, bytes, std::chrono::steady_clock::now() - start);
+  }
+
+  return 0;
+}
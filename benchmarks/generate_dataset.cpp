@@ -0,0 +1,53 @@
+// Writes a synthetic linear regression dataset for bench_stream_eval. Every
+// record holds three doubles (x1, x2, y) with y = 1.5 * x1 - 0.7 * x2 + 0.3
+// plus gaussian noise, stored back to back in native byte order.
+//
+// Usage: generate_dataset <path> [n_records]
+
+#include <array>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <vector>
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <path> [n_records]\n";
+    return 1;
+  }
+
+  const size_t n_records =
+      argc > 2 ? std::strtoull(argv[2], nullptr, 10) : 10000000;
+
+  std::ofstream out(argv[1], std::ios::binary | std::ios::trunc);
+  if (!out) {
+    std::cerr << "Could not open " << argv[1] << " for writing\n";
+    return 1;
+  }
+
+  std::mt19937_64 rng(42);
+  std::uniform_real_distribution<double> feature(-1.0, 1.0);
+  std::normal_distribution<double> noise(0.0, 0.1);
+
+  // Records are written in batches to keep the number of write calls low
+  constexpr size_t batch_size = 4096;
+  std::vector<std::array<double, 3>> batch;
+  batch.reserve(batch_size);
+
+  for (size_t i = 0; i < n_records; ++i) {
+    const double x1 = feature(rng);
+    const double x2 = feature(rng);
+    batch.push_back({x1, x2, 1.5 * x1 - 0.7 * x2 + 0.3 + noise(rng)});
+
+    if (batch.size() == batch_size || i + 1 == n_records) {
+      out.write(reinterpret_cast<const char *>(batch.data()),
+                static_cast<std::streamsize>(batch.size() * sizeof(batch[0])));
+      batch.clear();
+    }
+  }
+
+  std::cout << "Wrote " << n_records << " records to " << argv[1] << "\n";
+
+  return out.good() ? 0 : 1;
+}
@@ -1,6 +1,9 @@
 #define CATCH_CONFIG_MAIN
 #include <catch2/catch.hpp>
+#include <array>
 #include <cmath>
+#include <thread>
+#include <vector>
 #include <wfwdiff/wfwdiff.hpp>
 
 using val_t = double;
@@ -37,4 +40,86 @@ TEST_CASE("Test vectorized autodiff", "[core, autodiff]") {
   REQUIRE(ans.value == Approx(-12.385).epsilon(0.001));
   REQUIRE(ans.grad[0] == Approx(-12.385).epsilon(0.001));
   REQUIRE(ans.grad[1] == Approx(-21.176).epsilon(0.001));
-}
\ No newline at end of file
+}
+
+TEST_CASE("Test eval leaves inputs untouched", "[core, autodiff]") {
+  scalar_t x(3.2, 0.5);
+  scalar_t y = 2.1;
+
+  const auto ans_dx =
+      wfwdiff::eval(f_scalar, wfwdiff::wrt(x), wfwdiff::at(x, y));
+  const auto ans_vec =
+      wfwdiff::eval(f_vec, wfwdiff::parallelWrt(x, y), wfwdiff::at(x, y));
+
+  REQUIRE(ans_dx.grad == Approx(-12.385).epsilon(0.001));
+  REQUIRE(ans_vec.grad[1] == Approx(-21.176).epsilon(0.001));
+
+  REQUIRE(x.value == 3.2);
+  REQUIRE(x.grad == 0.5);
+  REQUIRE(y.value == 2.1);
+  REQUIRE(y.grad == 0.0);
+}
+
+TEST_CASE("Test concurrent eval over shared inputs", "[core, autodiff]") {
+  constexpr size_t n_threads = 8;
+  constexpr size_t n_iterations = 10000;
+
+  const scalar_t x = 3.2;
+  const scalar_t y = 2.1;
+
+  std::array<bool, n_threads> all_correct{};
+  std::vector<std::thread> threads;
+
+  for (size_t t = 0; t < n_threads; ++t) {
+    threads.emplace_back([&, t]() {
+      bool correct = true;
+      for (size_t i = 0; i < n_iterations; ++i) {
+        const auto ans_dy =
+            wfwdiff::eval(f_scalar, wfwdiff::wrt(y), wfwdiff::at(x, y));
+        const auto ans_vec =
+            wfwdiff::eval(f_vec, wfwdiff::parallelWrt(x, y), wfwdiff::at(x, y));
+
+        correct &= std::abs(ans_dy.grad + 21.176) < 0.01;
+        correct &= std::abs(ans_vec.grad[0] + 12.385) < 0.01;
+        correct &= std::abs(ans_vec.grad[1] + 21.176) < 0.01;
+      }
+      all_correct[t] = correct;
+    });
+  }
+
+  for (auto &thread : threads)
+    thread.join();
+
+  for (const auto correct : all_correct)
+    REQUIRE(correct);
+}
+
+scalar_t f_scaled(scalar_t x, double c) { return x * x * c; }
+
+TEST_CASE("Test wrt with plain values in at", "[core, autodiff]") {
+  scalar_t x = 3.0;
+  const double c = 2.0;
+
+  const auto ans = wfwdiff::eval(f_scaled, wfwdiff::wrt(x), wfwdiff::at(x, c));
+
+  REQUIRE(ans.value == Approx(18.0));
+  REQUIRE(ans.grad == Approx(12.0));
+}
+
+struct weighted_scalar {
+  scalar_t x;
+  double grad;
+};
+
+scalar_t f_weighted(weighted_scalar w, scalar_t x) { return w.x * w.grad + x; }
+
+TEST_CASE("Test wrt matches argument types", "[core, autodiff]") {
+  weighted_scalar w{3.0, 2.0};
+
+  // w shares its address with w.x, but only w.x is differentiated
+  const auto ans =
+      wfwdiff::eval(f_weighted, wfwdiff::wrt(w.x), wfwdiff::at(w, w.x));
+
+  REQUIRE(ans.value == Approx(9.0));
+  REQUIRE(ans.grad == Approx(1.0));
+}
@@ -0,0 +1,201 @@
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <span>
+#include <thread>
+#include <vector>
+#include <wfwdiff/wfwdiff.hpp>
+
+using val_t = double;
+using scalar_t = wfwdiff::var<val_t, val_t>;
+using dyn_t = wfwdiff::var<val_t, wfwdiff::dynamic_vector<val_t>>;
+
+dyn_t f_dyn(std::span<const dyn_t> p) {
+  return std::exp(p[0]) * std::cos(p[1]);
+}
+
+// Sum of (i+1) * p_i^2, its gradient is 2 * (i+1) * p_i
+dyn_t f_weighted_squares(std::span<const dyn_t> p) {
+  dyn_t sum = 0.0;
+  for (size_t i = 0; i < p.size(); ++i)
+    sum = sum + p[i] * p[i] * static_cast<val_t>(i + 1);
+
+  return sum;
+}
+
+std::vector<scalar_t> make_params(const size_t width) {
+  std::vector<scalar_t> params;
+  for (size_t i = 0; i < width; ++i)
+    params.emplace_back(0.5 + static_cast<val_t>(i));
+
+  return params;
+}
+
+bool has_weighted_squares_grad(const dyn_t &ans,
+                               const std::vector<scalar_t> &params) {
+  bool correct = ans.grad.size() == params.size();
+  for (size_t i = 0; correct && i < params.size(); ++i)
+    correct = ans.grad[i] ==
+              Approx(2.0 * static_cast<val_t>(i + 1) * params[i].value);
+
+  return correct;
+}
+
+dyn_t eval_weighted_squares(const std::vector<scalar_t> &params) {
+  return wfwdiff::eval(f_weighted_squares, wfwdiff::dynamicWrt(params),
+                       wfwdiff::at(params));
+}
+
+TEST_CASE("Test dynamic width autodiff", "[core, autodiff]") {
+  std::vector<scalar_t> params = {3.2, 2.1};
+
+  const auto ans =
+      wfwdiff::eval(f_dyn, wfwdiff::dynamicWrt(params), wfwdiff::at(params));
+
+  REQUIRE(ans.grad.size() == 2);
+  REQUIRE(ans.value == Approx(-12.385).epsilon(0.001));
+  REQUIRE(ans.grad[0] == Approx(-12.385).epsilon(0.001));
+  REQUIRE(ans.grad[1] == Approx(-21.176).epsilon(0.001));
+
+  REQUIRE(params[0].grad == 0.0);
+  REQUIRE(params[1].grad == 0.0);
+}
+
+TEST_CASE("Test dynamic width beyond inline storage", "[core, autodiff]") {
+  for (const size_t width : {1, 8, 9, 37, 100}) {
+    const auto params = make_params(width);
+
+    for (size_t round = 0; round < 2; ++round)
+      REQUIRE(has_weighted_squares_grad(eval_weighted_squares(params), params));
+  }
+}
+
+TEST_CASE("Test dynamic vector arithmetic", "[core, vector]") {
+  const std::vector<val_t> lhs = {1., 2., 3., 4., 5., 6., 7., 8., 9., 10.};
+  const std::vector<val_t> rhs = {2., 2., 2., 2., 2., 2., 2., 2., 2., 2.};
+
+  const wfwdiff::dynamic_vector<val_t> a(lhs);
+  const wfwdiff::dynamic_vector<val_t> b(rhs);
+
+  const auto sum = a + b;
+  const auto quot = a / b;
+  auto prod = a;
+  prod *= b;
+
+  for (size_t i = 0; i < lhs.size(); ++i) {
+    REQUIRE(sum[i] == lhs[i] + 2.);
+    REQUIRE(quot[i] == lhs[i] / 2.);
+    REQUIRE(prod[i] == lhs[i] * 2.);
+  }
+}
+
+TEST_CASE("Test accumulating results outside eval", "[core, autodiff]") {
+  std::vector<scalar_t> params = {3.2, 2.1};
+
+  dyn_t total;
+  dyn_t offset = 1.0;
+  REQUIRE(total.grad.size() == 0);
+
+  for (size_t i = 0; i < 3; ++i)
+    total = total + wfwdiff::eval(f_dyn, wfwdiff::dynamicWrt(params),
+                                  wfwdiff::at(params));
+
+  total = total + offset;
+
+  REQUIRE(total.grad.size() == 2);
+  REQUIRE(total.value == Approx(3 * -12.385 + 1.0).epsilon(0.001));
+  REQUIRE(total.grad[0] == Approx(3 * -12.385).epsilon(0.001));
+  REQUIRE(total.grad[1] == Approx(3 * -21.176).epsilon(0.001));
+
+  wfwdiff::dynamic_vector<val_t> grad_sum;
+  grad_sum += total.grad;
+  REQUIRE(grad_sum.size() == 2);
+  REQUIRE(grad_sum[1] == total.grad[1]);
+}
+
+TEST_CASE("Test dynamic vector width mismatch", "[core, vector]") {
+  const std::vector<val_t> two = {1., 2.};
+  const std::vector<val_t> three = {1., 2., 3.};
+
+  const wfwdiff::dynamic_vector<val_t> a(two);
+  wfwdiff::dynamic_vector<val_t> b(three);
+
+  REQUIRE_THROWS_AS(a + b, std::invalid_argument);
+  REQUIRE_THROWS_AS(b -= a, std::invalid_argument);
+}
+
+TEST_CASE("Test SIMD dynamic vector arithmetic", "[core, vector]") {
+  // 11 lanes leave a remainder after the full SIMD batches
+  std::vector<val_t> lhs;
+  for (size_t i = 0; i < 11; ++i)
+    lhs.push_back(1.0 + static_cast<val_t>(i));
+
+  const wfwdiff::dynamic_vector<val_t, true> a(lhs);
+
+  const auto sum = a + a;
+  const auto scaled = a * 3.0;
+  const auto halved = a / 2.0;
+
+  for (size_t i = 0; i < lhs.size(); ++i) {
+    REQUIRE(sum[i] == 2. * lhs[i]);
+    REQUIRE(scaled[i] == 3. * lhs[i]);
+    REQUIRE(halved[i] == lhs[i] / 2.);
+  }
+}
+
+TEST_CASE("Test pooled blocks are reused across evals", "[core, vector]") {
+  const auto params = make_params(40);
+  const auto &pool = wfwdiff::generic_vec::detail::block_pool<val_t>::local();
+
+  {
+    const auto ans = eval_weighted_squares(params);
+  }
+  const size_t cached = pool.cached_blocks();
+
+  // Without reuse the second eval would allocate and then cache new blocks
+  {
+    const auto ans = eval_weighted_squares(params);
+  }
+
+  REQUIRE(pool.width() == 40);
+  REQUIRE(cached > 0);
+  REQUIRE(pool.cached_blocks() == cached);
+}
+
+TEST_CASE("Test results outlive evals of another width", "[core, vector]") {
+  const auto wide_params = make_params(100);
+  const auto narrow_params = make_params(20);
+  const auto &pool = wfwdiff::generic_vec::detail::block_pool<val_t>::local();
+
+  auto wide = eval_weighted_squares(wide_params);
+  const auto narrow = eval_weighted_squares(narrow_params);
+
+  // The width change dropped the blocks cached for width 100
+  REQUIRE(pool.width() == 20);
+  const size_t cached = pool.cached_blocks();
+
+  REQUIRE(has_weighted_squares_grad(wide, wide_params));
+  REQUIRE(has_weighted_squares_grad(narrow, narrow_params));
+
+  // A block of the old width is released instead of being cached
+  wide = dyn_t();
+  REQUIRE(pool.cached_blocks() == cached);
+}
+
+TEST_CASE("Test results destroyed on another thread", "[core, vector]") {
+  const auto params = make_params(40);
+  const auto &pool = wfwdiff::generic_vec::detail::block_pool<val_t>::local();
+
+  auto ans = eval_weighted_squares(params);
+  const size_t cached = pool.cached_blocks();
+
+  bool correct = false;
+  std::thread([&]() {
+    const auto moved = std::move(ans);
+    correct = has_weighted_squares_grad(moved, params);
+  }).join();
+
+  REQUIRE(correct);
+  REQUIRE(ans.grad.size() == 0);
+  REQUIRE(pool.cached_blocks() == cached);
+}
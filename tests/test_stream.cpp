@@ -0,0 +1,76 @@
+#define CATCH_CONFIG_MAIN
+#include <array>
+#include <catch2/catch.hpp>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <vector>
+#include <wfwdiff/stream.hpp>
+#include <wfwdiff/wfwdiff.hpp>
+
+using val_t = double;
+using scalar_t = wfwdiff::var<val_t, val_t>;
+using vec_t = wfwdiff::var<val_t, wfwdiff::vector<val_t, 2>>;
+
+// Weighted squared error of a linear model on a single (x, y, w) record
+vec_t loss(std::span<const val_t> record, vec_t a, vec_t b) {
+  const auto residual = a * record[0] + b - vec_t(record[1]);
+  return vec_t(record[2]) * residual * residual;
+}
+
+std::string write_records(const std::vector<std::array<val_t, 3>> &records) {
+  const auto path =
+      (std::filesystem::temp_directory_path() / "wfwdiff_test_stream.bin")
+          .string();
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(reinterpret_cast<const char *>(records.data()),
+            static_cast<std::streamsize>(records.size() * sizeof(records[0])));
+
+  return path;
+}
+
+TEST_CASE("Test streamed gradient matches in-memory loop", "[stream]") {
+  std::vector<std::array<val_t, 3>> data;
+  for (size_t i = 0; i < 5000; ++i)
+    data.push_back({0.001 * i, 2.0 * 0.001 * i + 1.0, 1.0 + (i % 3)});
+
+  const auto path = write_records(data);
+
+  const scalar_t a = 1.5;
+  const scalar_t b = 0.5;
+
+  vec_t expected;
+  for (const auto &record : data) {
+    expected = expected + wfwdiff::eval(
+                              [&record](vec_t pa, vec_t pb) {
+                                return loss(record, pa, pb);
+                              },
+                              wfwdiff::parallelWrt(a, b), wfwdiff::at(a, b));
+  }
+
+  {
+    const wfwdiff::mapped_records<val_t> records(path, 3);
+    REQUIRE(records.size() == data.size());
+
+    // Single page chunks make 24 byte records straddle chunk boundaries
+    const auto ans =
+        wfwdiff::eval_stream(loss, wfwdiff::parallelWrt(a, b), records, 1);
+
+    REQUIRE(ans.value == Approx(expected.value));
+    REQUIRE(ans.grad[0] == Approx(expected.grad[0]));
+    REQUIRE(ans.grad[1] == Approx(expected.grad[1]));
+  }
+
+  std::remove(path.c_str());
+}
+
+TEST_CASE("Test mapped records reject partial records", "[stream]") {
+  const auto path = write_records({{1.0, 2.0, 3.0}});
+
+  REQUIRE_THROWS_AS(wfwdiff::mapped_records<val_t>(path, 2),
+                    std::runtime_error);
+
+  std::remove(path.c_str());
+}
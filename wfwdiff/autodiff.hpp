@@ -3,10 +3,16 @@
 
 #include <cmath>
 #include <concepts>
+#include <functional>
 #include <iostream>
+#include <ranges>
+#include <span>
 #include <tuple>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
+#include "dynamic_vector.hpp"
 #include "vector.hpp"
 
 namespace wfwdiff {
@@ -26,7 +32,7 @@ struct var {
 
   constexpr var() : value(), grad(){};
   constexpr var(T value) : value(value), grad(){};
-  constexpr var(T value, U grad) : value(value), grad(grad){};
+  constexpr var(T value, U grad) : value(value), grad(std::move(grad)){};
 
   constexpr var<T, U> operator+(const var<T, U> rhs) const {
     return var<T, U>(value + rhs.value, grad + rhs.grad);
@@ -79,13 +85,10 @@ template <typename... Args> struct ParallelWrt {
   ParallelWrt(std::tuple<Args...> args) : args(args){};
 };
 
-template <typename... Elem> constexpr auto seed(std::tuple<Elem...> wrt) {
-  std::apply([](auto &&...args) { ((args.grad = 1), ...); }, wrt);
-}
-
-template <typename... Elem> constexpr auto unseed(std::tuple<Elem...> wrt) {
-  std::apply([](auto &&...args) { ((args.grad = 0), ...); }, wrt);
-}
+template <typename V> struct DynamicWrt {
+  std::span<const V> args;
+  DynamicWrt(std::span<const V> args) : args(args){};
+};
 
 template <typename... Args> constexpr auto at(Args &&...args) {
   return At<Args...>(std::forward_as_tuple<Args...>(args...));
@@ -99,35 +102,82 @@ template <typename... Args> constexpr auto parallelWrt(Args &&...args) {
   return ParallelWrt<Args...>(std::forward_as_tuple<Args...>(args...));
 }
 
+template <std::ranges::contiguous_range R>
+constexpr auto dynamicWrt(const R &params) {
+  return DynamicWrt<std::ranges::range_value_t<R>>(std::span(params));
+}
+
 namespace detail {
-template <size_t I = 0, size_t W = 1, typename T, typename... Args>
-auto vectorize_scalar_argument(std::tuple<Args...> &args,
+// Identifies wrt arguments by type and address, so seeding never has to write
+// into the caller's variables and concurrent evals over shared inputs stay
+// race-free.
+template <typename T, typename... DVars>
+constexpr bool is_wrt(const T &arg, const std::tuple<DVars...> &wrt) {
+  return std::apply(
+      [&arg](const auto &...dvars) {
+        return ((std::is_same_v<std::decay_t<T>,
+                                std::decay_t<decltype(dvars)>> &&
+                 static_cast<const void *>(&dvars) ==
+                     static_cast<const void *>(&arg)) ||
+                ...);
+      },
+      wrt);
+}
+
+template <typename T, typename... DVars>
+constexpr auto seed_copy(const T &arg, const std::tuple<DVars...> &wrt) {
+  auto seeded = arg;
+  // Constants and data passed to at() are copied unchanged
+  if constexpr (requires { seeded.grad; }) {
+    if (is_wrt(arg, wrt))
+      seeded.grad = 1;
+  }
+
+  return seeded;
+}
+
+template <typename... DVars, typename... Args>
+constexpr auto seed_args(const std::tuple<DVars...> &wrt,
+                         const std::tuple<Args...> &args) {
+  return std::apply(
+      [&wrt](const auto &...arg) {
+        return std::make_tuple(seed_copy(arg, wrt)...);
+      },
+      args);
+}
+
+template <size_t I = 0, size_t W = 1, typename T, typename... DVars,
+          typename... Args>
+auto vectorize_scalar_argument(const std::tuple<DVars...> &wrt,
+                               const std::tuple<Args...> &args,
                                std::array<T, W> &vectorized_args) {
-  const auto current_arg = std::get<I>(args);
-  using grad_t = decltype(current_arg.grad);
+  const auto &current_arg = std::get<I>(args);
+  using grad_t = std::decay_t<decltype(current_arg.grad)>;
 
   auto vectorized_grad = generic_vec::vector<grad_t, W>();
-  if (current_arg.grad == 1.0)
+  if (is_wrt(current_arg, wrt))
     vectorized_grad[I] = 1.0;
 
   const auto new_arg = var(current_arg.value, vectorized_grad);
   vectorized_args[I] = new_arg;
 
   if constexpr (I + 1 != sizeof...(Args))
-    vectorize_scalar_argument<I + 1, W, T, Args...>(args, vectorized_args);
+    vectorize_scalar_argument<I + 1>(wrt, args, vectorized_args);
 }
 
-template <typename... Args> auto vectorize_args(std::tuple<Args...> args) {
+template <typename... DVars, typename... Args>
+auto vectorize_args(const std::tuple<DVars...> &wrt,
+                    const std::tuple<Args...> &args) {
   constexpr size_t arg_length = sizeof...(Args);
 
-  const auto elem0 = std::get<0>(args);
-  using val_t = decltype(elem0.value);
-  using grad_t = decltype(elem0.grad);
+  const auto &elem0 = std::get<0>(args);
+  using val_t = std::decay_t<decltype(elem0.value)>;
+  using grad_t = std::decay_t<decltype(elem0.grad)>;
 
   std::array<var<val_t, vector<grad_t, arg_length>>, arg_length>
       vectorized_args;
 
-  vectorize_scalar_argument(args, vectorized_args);
+  vectorize_scalar_argument(wrt, args, vectorized_args);
 
   return vectorized_args;
 }
@@ -135,29 +185,48 @@ template <typename... Args> auto vectorize_args(std::tuple<Args...> args) {
 
 template <typename F, typename... DVars, typename... Args>
 auto eval(const F &&func, Wrt<DVars...> wrt, At<Args...> at) {
-  seed(wrt.args);
-
-  const auto ans = std::apply(func, at.args);
-
-  unseed(wrt.args);
-
-  return ans;
+  return std::apply(func, detail::seed_args(wrt.args, at.args));
 }
 
 template <typename F, typename... DVars, typename... Args>
 auto eval(const F &&func, ParallelWrt<DVars...> wrt, At<Args...> at) {
-  seed(wrt.args);
+  return std::apply(func, detail::vectorize_args(wrt.args, at.args));
+}
+
+// Differentiates wrt a range of parameters whose size is only known at
+// runtime. func receives the parameters as a span of vars with
+// dynamic_vector gradients, element i of the range being seeded in lane i.
+template <typename F, typename V, typename R>
+auto eval(const F &&func, DynamicWrt<V> wrt, At<R> at) {
+  using val_t = std::decay_t<decltype(std::declval<V>().value)>;
+  using grad_t = std::decay_t<decltype(std::declval<V>().grad)>;
+  using dynamic_var_t = var<val_t, generic_vec::dynamic_vector<grad_t>>;
+
+  const generic_vec::width_scope scope(wrt.args.size());
+
+  const auto &params = std::get<0>(at.args);
+  const V *wrt_begin = wrt.args.data();
+  const V *wrt_end = wrt_begin + wrt.args.size();
+
+  std::vector<dynamic_var_t> seeded;
+  seeded.reserve(std::ranges::size(params));
 
-  const auto ans = std::apply(func, detail::vectorize_args(at.args));
+  for (const auto &param : params) {
+    auto grad = generic_vec::dynamic_vector<grad_t>();
+    if (!std::less<const V *>()(&param, wrt_begin) &&
+        std::less<const V *>()(&param, wrt_end))
+      grad[&param - wrt_begin] = 1;
 
-  unseed(wrt.args);
+    seeded.emplace_back(param.value, std::move(grad));
+  }
 
-  return ans;
+  return func(std::span<const dynamic_var_t>(seeded));
 }
 
 } // End namespace autodiff
 
 using autodiff::at;
+using autodiff::dynamicWrt;
 using autodiff::eval;
 using autodiff::parallelWrt;
 using autodiff::var;
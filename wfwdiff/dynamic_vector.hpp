@@ -0,0 +1,338 @@
+#ifndef WFWDIFF_DYNAMIC_VECTOR_H
+#define WFWDIFF_DYNAMIC_VECTOR_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <iostream>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// clang-format off
+#include "xsimd/xsimd.hpp"
+#include "xsimd/stl/algorithms.hpp"
+// clang-format on
+
+#include "vector.hpp"
+
+namespace wfwdiff {
+namespace generic_vec {
+
+namespace detail {
+// Width of every dynamic_vector created on this thread, set per eval
+inline thread_local size_t dynamic_width = 0;
+
+// Recycles heap blocks of a single width, so that once an eval has warmed up
+// the pool no arithmetic operation has to allocate. Blocks are individually
+// allocated, which keeps results valid after their eval and across threads.
+template <typename T> class block_pool {
+private:
+  static constexpr std::align_val_t ALIGNMENT{64};
+
+  size_t width_ = 0;
+  std::vector<T *> free_;
+
+  static void release(T *block) { ::operator delete(block, ALIGNMENT); }
+
+public:
+  ~block_pool() { reset(0); };
+
+  static block_pool &local() {
+    thread_local block_pool pool;
+    return pool;
+  }
+
+  // Drops all cached blocks once the width differs from the previous eval
+  void reset(const size_t width) {
+    if (width == width_)
+      return;
+
+    std::for_each(free_.begin(), free_.end(), release);
+    free_.clear();
+    width_ = width;
+  };
+
+  T *allocate(const size_t width) {
+    reset(width);
+
+    if (free_.empty())
+      return static_cast<T *>(::operator new(width * sizeof(T), ALIGNMENT));
+
+    T *block = free_.back();
+    free_.pop_back();
+    return block;
+  };
+
+  void deallocate(T *block, const size_t width) {
+    if (width == width_)
+      free_.push_back(block);
+    else
+      release(block);
+  };
+
+  size_t width() const { return width_; };
+
+  size_t cached_blocks() const { return free_.size(); };
+};
+} // namespace detail
+
+// Sets the width of dynamic_vectors created on this thread for its lifetime
+class width_scope {
+private:
+  size_t previous_;
+
+public:
+  explicit width_scope(const size_t width) : previous_(detail::dynamic_width) {
+    detail::dynamic_width = width;
+  };
+
+  width_scope(const width_scope &) = delete;
+  width_scope &operator=(const width_scope &) = delete;
+
+  ~width_scope() { detail::dynamic_width = previous_; };
+};
+
+// A tangent vector whose width is only known at runtime. Widths up to
+// INLINE_WIDTH are stored inline, larger ones in blocks from a thread-local
+// pool.
+template <typename T, bool USE_SIMD = SIMD_ACTIVE> struct dynamic_vector {
+  static constexpr size_t INLINE_WIDTH = 64 / sizeof(T);
+
+private:
+  size_t width_;
+  T *data_;
+  std::array<T, INLINE_WIDTH> inline_;
+
+  bool is_inline() const { return data_ == inline_.data(); };
+
+  void allocate() {
+    data_ = width_ <= INLINE_WIDTH
+                ? inline_.data()
+                : detail::block_pool<T>::local().allocate(width_);
+  };
+
+  void deallocate() {
+    if (!is_inline())
+      detail::block_pool<T>::local().deallocate(data_, width_);
+  };
+
+  template <typename Op>
+  static void transform(const T *lhs, const T *rhs, T *out, const size_t width,
+                        Op op) {
+    if constexpr (USE_SIMD)
+      xsimd::transform(lhs, lhs + width, rhs, out, op);
+    else
+      std::transform(lhs, lhs + width, rhs, out, op);
+  }
+
+  static dynamic_vector zeros(const size_t width) {
+    dynamic_vector result(width, uninitialized{});
+    std::fill_n(result.data_, width, T());
+
+    return result;
+  }
+
+  // A width 0 tangent, e.g. of a constant created outside of eval, is a zero
+  // of any width. Other differing widths cannot be combined.
+  void check_broadcastable(const dynamic_vector &rhs) const {
+    if (width_ != 0 && rhs.width_ != 0)
+      throw std::invalid_argument(
+          "wfwdiff: dynamic_vector widths " + std::to_string(width_) +
+          " and " + std::to_string(rhs.width_) + " do not match");
+  }
+
+  template <typename Op>
+  dynamic_vector apply(const dynamic_vector &rhs, Op op) const {
+    if (width_ != rhs.width_) {
+      check_broadcastable(rhs);
+      return width_ == 0 ? zeros(rhs.width_).apply(rhs, op)
+                         : apply(zeros(width_), op);
+    }
+
+    dynamic_vector result(width_, uninitialized{});
+    transform(data_, rhs.data_, result.data_, width_, op);
+
+    return result;
+  }
+
+  template <typename Op> dynamic_vector apply(const T rhs, Op op) const {
+    dynamic_vector result(width_, uninitialized{});
+
+    size_t i = 0;
+    if constexpr (USE_SIMD) {
+      using batch_t = xsimd::batch<T>;
+      const batch_t scalar(rhs);
+
+      for (; i + batch_t::size <= width_; i += batch_t::size)
+        op(batch_t::load_unaligned(data_ + i), scalar)
+            .store_unaligned(result.data_ + i);
+    }
+
+    for (; i < width_; ++i)
+      result.data_[i] = op(data_[i], rhs);
+
+    return result;
+  }
+
+  template <typename Op>
+  dynamic_vector &apply_inplace(const dynamic_vector &rhs, Op op) {
+    if (width_ != rhs.width_) {
+      check_broadcastable(rhs);
+      if (rhs.width_ == 0)
+        return apply_inplace(zeros(width_), op);
+
+      *this = zeros(rhs.width_);
+    }
+
+    transform(data_, rhs.data_, data_, width_, op);
+
+    return *this;
+  }
+
+  struct uninitialized {};
+
+  dynamic_vector(const size_t width, uninitialized) : width_(width) {
+    allocate();
+  };
+
+public:
+  dynamic_vector() : dynamic_vector(T()){};
+
+  dynamic_vector(const T initializer)
+      : dynamic_vector(detail::dynamic_width, uninitialized{}) {
+    std::fill_n(data_, width_, initializer);
+  };
+
+  dynamic_vector(std::span<const T> input)
+      : dynamic_vector(input.size(), uninitialized{}) {
+    std::copy(input.begin(), input.end(), data_);
+  };
+
+  dynamic_vector(const dynamic_vector &vec)
+      : dynamic_vector(vec.width_, uninitialized{}) {
+    std::copy_n(vec.data_, width_, data_);
+  };
+
+  dynamic_vector(dynamic_vector &&vec) noexcept : width_(vec.width_) {
+    if (vec.is_inline()) {
+      data_ = inline_.data();
+      std::copy_n(vec.data_, width_, data_);
+    } else {
+      data_ = vec.data_;
+      vec.width_ = 0;
+      vec.data_ = vec.inline_.data();
+    }
+  };
+
+  dynamic_vector &operator=(const dynamic_vector &rhs) {
+    if (this == &rhs)
+      return *this;
+
+    if (width_ != rhs.width_) {
+      deallocate();
+      width_ = rhs.width_;
+      allocate();
+    }
+    std::copy_n(rhs.data_, width_, data_);
+
+    return *this;
+  };
+
+  dynamic_vector &operator=(dynamic_vector &&rhs) noexcept {
+    if (this == &rhs)
+      return *this;
+
+    if (rhs.is_inline())
+      return *this = static_cast<const dynamic_vector &>(rhs);
+
+    deallocate();
+    width_ = rhs.width_;
+    data_ = rhs.data_;
+    rhs.width_ = 0;
+    rhs.data_ = rhs.inline_.data();
+
+    return *this;
+  };
+
+  ~dynamic_vector() { deallocate(); };
+
+  auto operator+(const dynamic_vector &rhs) const {
+    return apply(rhs, [](const auto &x, const auto &y) { return x + y; });
+  };
+
+  auto operator-(const dynamic_vector &rhs) const {
+    return apply(rhs, [](const auto &x, const auto &y) { return x - y; });
+  };
+
+  auto operator*(const dynamic_vector &rhs) const {
+    return apply(rhs, [](const auto &x, const auto &y) { return x * y; });
+  };
+
+  auto operator/(const dynamic_vector &rhs) const {
+    return apply(rhs, [](const auto &x, const auto &y) { return x / y; });
+  };
+
+  auto operator*(const T rhs) const {
+    return apply(rhs, [](const auto &x, const auto &y) { return x * y; });
+  };
+
+  auto operator/(const T rhs) const {
+    return apply(rhs, [](const auto &x, const auto &y) { return x / y; });
+  };
+
+  dynamic_vector &operator+=(const dynamic_vector &rhs) {
+    return apply_inplace(rhs,
+                         [](const auto &x, const auto &y) { return x + y; });
+  };
+
+  dynamic_vector &operator-=(const dynamic_vector &rhs) {
+    return apply_inplace(rhs,
+                         [](const auto &x, const auto &y) { return x - y; });
+  };
+
+  dynamic_vector &operator*=(const dynamic_vector &rhs) {
+    return apply_inplace(rhs,
+                         [](const auto &x, const auto &y) { return x * y; });
+  };
+
+  dynamic_vector &operator/=(const dynamic_vector &rhs) {
+    return apply_inplace(rhs,
+                         [](const auto &x, const auto &y) { return x / y; });
+  };
+
+  const T &operator[](const size_t idx) const { return data_[idx]; }
+
+  T &operator[](const size_t idx) { return data_[idx]; }
+
+  std::span<const T> data() const {
+    return std::span<const T>(data_, width_);
+  };
+
+  std::span<T> data() { return std::span<T>(data_, width_); };
+
+  size_t size() const { return width_; };
+};
+
+template <typename T, bool USE_SIMD>
+std::ostream &operator<<(std::ostream &os,
+                         const dynamic_vector<T, USE_SIMD> &vec) {
+  os << "[";
+
+  for (size_t i = 0; i < vec.size(); ++i)
+    os << (i == 0 ? "" : ",") << vec[i];
+
+  os << "]";
+
+  return os;
+}
+
+} // namespace generic_vec
+
+using generic_vec::dynamic_vector;
+
+} // namespace wfwdiff
+
+#endif // WFWDIFF_DYNAMIC_VECTOR_H
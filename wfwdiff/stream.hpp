@@ -0,0 +1,160 @@
+#ifndef WFWDIFF_STREAM_H
+#define WFWDIFF_STREAM_H
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "autodiff.hpp"
+
+namespace wfwdiff {
+namespace stream {
+
+// Default chunk size for eval_stream, roughly the size of a per-core L2 cache
+static constexpr size_t DEFAULT_CHUNK_BYTES = 256 * 1024;
+
+// A read-only memory mapping of a binary file made of fixed-width records of
+// T, stored back to back in native byte order without any header.
+template <typename T> class mapped_records {
+private:
+  const T *data_ = nullptr;
+  size_t bytes_ = 0;
+  size_t record_width_;
+
+public:
+  mapped_records(const std::string &path, const size_t record_width)
+      : record_width_(record_width) {
+    if (record_width_ == 0)
+      throw std::invalid_argument("wfwdiff: record width must be non-zero");
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+      throw std::system_error(errno, std::generic_category(), path);
+
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+      const int err = errno;
+      ::close(fd);
+      throw std::system_error(err, std::generic_category(), path);
+    }
+
+    bytes_ = static_cast<size_t>(st.st_size);
+    if (bytes_ % (record_width_ * sizeof(T)) != 0) {
+      ::close(fd);
+      throw std::runtime_error("wfwdiff: " + path +
+                               " does not hold a whole number of records");
+    }
+
+    if (bytes_ != 0) {
+      void *addr = ::mmap(nullptr, bytes_, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr == MAP_FAILED) {
+        const int err = errno;
+        ::close(fd);
+        throw std::system_error(err, std::generic_category(), path);
+      }
+      data_ = static_cast<const T *>(addr);
+      ::madvise(addr, bytes_, MADV_SEQUENTIAL);
+    }
+
+    // The mapping stays valid after the descriptor is closed
+    ::close(fd);
+  };
+
+  mapped_records(const mapped_records &) = delete;
+  mapped_records &operator=(const mapped_records &) = delete;
+
+  ~mapped_records() {
+    if (data_ != nullptr)
+      ::munmap(const_cast<T *>(data_), bytes_);
+  };
+
+  std::span<const T> operator[](const size_t idx) const {
+    return std::span<const T>(data_ + idx * record_width_, record_width_);
+  }
+
+  size_t size() const { return bytes_ / (record_width_ * sizeof(T)); };
+
+  size_t record_width() const { return record_width_; };
+
+  size_t bytes() const { return bytes_; };
+
+  const T *data() const { return data_; };
+};
+
+namespace detail {
+inline void advise(const void *base, const size_t begin, const size_t end,
+                   const int advice) {
+  if (begin >= end)
+    return;
+
+  ::madvise(const_cast<char *>(static_cast<const char *>(base) + begin),
+            end - begin, advice);
+}
+} // namespace detail
+
+// Evaluates objective(record, params...) for every record and returns the sum
+// of all results, i.e. the accumulated value and gradient wrt params.
+//
+// The file is walked in page-aligned chunks of about chunk_bytes. While a
+// chunk is being evaluated the kernel is asked to read the next one ahead, so
+// I/O overlaps with compute, and finished chunks are released from the mapping
+// to keep the resident set bounded by a few chunks.
+template <typename T, typename F, typename... DVars>
+auto eval_stream(const F &objective, autodiff::ParallelWrt<DVars...> wrt,
+                 const mapped_records<T> &records,
+                 size_t chunk_bytes = DEFAULT_CHUNK_BYTES) {
+  const auto at = autodiff::At<DVars...>(wrt.args);
+
+  const auto evaluate = [&](const size_t idx) {
+    const auto record = records[idx];
+    return autodiff::eval(
+        [&objective, record](auto... params) {
+          return objective(record, params...);
+        },
+        wrt, at);
+  };
+
+  auto total = decltype(evaluate(0))();
+
+  const size_t page_bytes = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+  const size_t record_bytes = records.record_width() * sizeof(T);
+  chunk_bytes = std::max(page_bytes, chunk_bytes - chunk_bytes % page_bytes);
+
+  size_t idx = 0;
+  for (size_t begin = 0; begin < records.bytes(); begin += chunk_bytes) {
+    const size_t end = std::min(begin + chunk_bytes, records.bytes());
+
+    detail::advise(records.data(), end,
+                   std::min(end + chunk_bytes, records.bytes()),
+                   MADV_WILLNEED);
+
+    // Records starting in this chunk, the last one may spill into the next
+    for (; idx < records.size() && idx * record_bytes < end; ++idx)
+      total = total + evaluate(idx);
+
+    // No record starting in a later chunk touches this one any more
+    detail::advise(records.data(), begin, end, MADV_DONTNEED);
+  }
+
+  return total;
+}
+
+} // namespace stream
+
+using stream::eval_stream;
+using stream::mapped_records;
+
+} // namespace wfwdiff
+
+#endif // WFWDIFF_STREAM_H
@@ -2,6 +2,7 @@
 #define WFWDIFF_H
 
 #include "autodiff.hpp"
+#include "dynamic_vector.hpp"
 #include "numerics.hpp"
 #include "vector.hpp"
 